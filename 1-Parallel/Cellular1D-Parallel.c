@@ -23,10 +23,22 @@ SOFTWARE.
 #include <stdio.h>
 #include <mpi.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef TOPOLOGY_AWARE
+#define TOPOLOGY_AWARE 0 // Reorder ranks so ring neighbours share a node where possible.
+#endif
+#ifndef STATISTICS
+#define STATISTICS 0 // Write population and change counts of every generation to STATISTICS_FILE.
+#endif
+#ifndef STATISTICS_FILE
+#define STATISTICS_FILE "statistics.txt"
+#endif
 
 void checkInput(int argc) {
-    if (argc != 4) {
-        fprintf(stderr, "Bad input. Expecting: {functionDefinition.txt} {initialConfiguration.txt} {t = time/turns}");
+    if (argc != 4 && argc != 5) {
+        fprintf(stderr, "Bad input. Expecting: {functionDefinition.txt} {initialConfiguration.txt} {t = time/turns} [finalConfiguration.txt]");
         exit(EXIT_FAILURE);
     }
 }
@@ -43,6 +55,14 @@ FILE *openFile(char *fileName) {
     } else return fp;
 }
 
+FILE *createFile(char *fileName) {
+    FILE *fp = fopen(fileName, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "Could not create %s.\n", fileName);
+        exit(EXIT_FAILURE);
+    } else return fp;
+}
+
 void setRange(char *function, char *fileName) {
 
     FILE *fp = openFile(fileName);
@@ -76,20 +96,58 @@ int readConfigLength(char *fileName) {
 void readConfigState(char *fileName, int len, char *config) {
 
     FILE *fp = openFile(fileName);
+    char header[32]; // The line holding n, read on its own so it is consumed whatever its length.
     char temp[len + 1];
-    fgets(temp, len + 1, fp);
-    fgets(temp, len + 1, fp);
+    if (fgets(header, sizeof(header), fp) == NULL || fgets(temp, len + 1, fp) == NULL) {
+        fprintf(stderr, "Bad configuration file, could not read %d cells.", len);
+        exit(EXIT_FAILURE);
+    }
     for (int i = 0; i < len; ++i)
         config[i] = temp[i];
     fclose(fp);
 }
 
-void stepConfig(int n, char **config, char left, char right, const char *transFunc) {
+void writeConfig(char *fileName, int len, const char *config) {
+
+    // Same format as the initial configuration, so every variant's final state can be compared with cmp.
+    FILE *fp = createFile(fileName);
+    fprintf(fp, "%d\n%.*s\n", len, len, config);
+    fclose(fp);
+}
+
+void writeStatistics(FILE *fp, int generation, long long cells, const long long *stats) {
+    // One line per generation: generation, population, cells changed since the previous one, density.
+    if (fp != NULL)
+        fprintf(fp, "%d %lld %lld %.6f\n", generation, stats[0], stats[1], (double) stats[0] / (double) cells);
+}
+
+void splitRange(int n, int commSize, int *counts, int *displs) {
+
+    // The n % commSize leftover cells go one each to the first ranks, so no cell is dropped.
+    for (int r = 0; r < commSize; ++r) {
+        counts[r] = n / commSize + (r < n % commSize);
+        displs[r] = r ? displs[r - 1] + counts[r - 1] : 0;
+    }
+}
+
+void stepConfig(int n, char **config, char left, char right, const char *transFunc, long long *stats) {
 
     char *current = *config;
     char *next = malloc((unsigned int) n * sizeof(char));
+#if STATISTICS
+    stats[0] = stats[1] = 0; // Population and changed cells of the new generation, counted while it is written.
+#else
+    (void) stats;
+#endif
     for (int x = 0; x < n; ++x) {
-        if (x == 0) {
+        if (n == 1) {
+            next[x] =
+                    transFunc[
+                            4 * (left - 48) +
+                            2 * (current[x] - 48) +
+                            (right - 48)
+                    ];
+        } else if (x == 0) {
             next[x] =
                     transFunc[
                             4 * (left - 48) +
@@ -111,64 +169,326 @@ void stepConfig(int n, char **config, char left, char right, const char *transFu
                             (current[x + 1] - 48)
                     ];
         }
+#if STATISTICS
+        stats[0] += next[x] - 48;
+        stats[1] += next[x] != current[x];
+#endif
     }
     free(*config);
     *config = next;
 }
 
+int isLinearRule(const char *transFunc) {
+    // Additive rules satisfy f(abc) = a*f(100) ^ b*f(010) ^ c*f(001) over GF(2), e.g. 60, 90, 102 and 150.
+    int l = transFunc[4] - 48, c = transFunc[2] - 48, r = transFunc[1] - 48;
+    for (int i = 0; i < 8; ++i)
+        if (transFunc[i] - 48 != ((l & (i >> 2)) ^ (c & (i >> 1)) ^ (r & i)))
+            return 0;
+    return 1;
+}
+
+int ownerOf(int x, int n, int commSize) {
+    // Inverse of splitRange: the first n % commSize ranks hold one cell more than the rest.
+    int base = n / commSize, extra = n % commSize;
+    return x < extra * (base + 1) ? x / (base + 1) : extra + (x - extra * (base + 1)) / base;
+}
+
+uint64_t readBits(const uint64_t *src, int words, int pos) {
+    // Returns the 64 bits of src starting at bit pos, bits past the last word read as 0.
+    int w = pos >> 6, s = pos & 63;
+    uint64_t bits = src[w] >> s;
+    if (s && w + 1 < words)
+        bits |= src[w + 1] << (64 - s);
+    return bits;
+}
+
+void orBits(uint64_t *dest, int pos, uint64_t bits, int count) {
+    // Ors the low count (1..64) bits into dest starting at bit pos.
+    if (count < 64)
+        bits &= ((uint64_t) 1 << count) - 1;
+    int w = pos >> 6, s = pos & 63;
+    dest[w] |= bits << s;
+    if (s && s + count > 64)
+        dest[w + 1] |= bits >> (64 - s);
+}
+
+int windowPieces(int start, int len, int n, int commSize, const int *counts, const int *displs, int *pieces) {
+
+    // Splits the cyclic window [start, start + len) by owning rank into {owner, offset, take, at} pieces:
+    // take cells from offset in the owner's slice land at position at in the window. Returns the number of
+    // pieces, which is at most three since no window is longer than a slice plus one cell.
+    int count = 0;
+    for (int at = 0, x = start; at < len; ++count) {
+        int owner = ownerOf(x, n, commSize);
+        int offset = x - displs[owner];
+        int take = counts[owner] - offset < len - at ? counts[owner] - offset : len - at;
+        int *piece = &pieces[4 * count];
+        piece[0] = owner, piece[1] = offset, piece[2] = take, piece[3] = at;
+        at += take;
+        x = (x + take) % n;
+    }
+    return count;
+}
+
+typedef struct {
+    int n, len, words;               // Ring size, cells and words of the local slice.
+    int myRank, commSize;
+    const int *counts, *displs;      // Slices of all ranks, as laid out by splitRange.
+    uint64_t l, c, r;                // Rule coefficients spread over a whole word.
+    uint64_t *current, *next;        // Local slice.
+    uint64_t *window[2];             // Cells at -d and +d of the slice.
+    uint64_t *sendBits, *recvBits;   // Message buffers for the pieces of both windows.
+    MPI_Comm comm;
+} SliceJump;
+
+void jumpRound(SliceJump *j, int d) {
+
+    // Applies p(x)^(2^k) = l*x^-d + c + r*x^d, d = 2^k mod n, to the local slice. The cells at -d and +d
+    // come from their owners, one message per piece; sender and receiver enumerate the pieces of the
+    // receiver's window the same way, so messages between a pair of ranks match in order.
+    int recvPieces[2][4 * 3], sendPieces[4 * 3], owners[4 * 3];
+    int recvCount[2];
+    MPI_Request requests[2 * 3 + 2 * 3 * 3];
+    int requestCount = 0, recvAt = 0, sendAt = 0;
+    int myLeft = j->displs[j->myRank];
+
+    for (int side = 0; side < 2; ++side) {
+        int shift = side ? d : -d;
+
+        recvCount[side] = windowPieces(mod(myLeft + shift, j->n), j->len, j->n, j->commSize, j->counts, j->displs, recvPieces[side]);
+        for (int i = 0; i < recvCount[side]; ++i) {
+            int *piece = &recvPieces[side][4 * i];
+            int words = (piece[2] + 63) / 64;
+            MPI_Irecv(j->recvBits + recvAt, words, MPI_UINT64_T, piece[0], side, j->comm, &requests[requestCount++]);
+            recvAt += words;
+        }
+
+        // My cells are read by the owners of my slice shifted back by the same distance.
+        int ownerCount = windowPieces(mod(myLeft - shift, j->n), j->len, j->n, j->commSize, j->counts, j->displs, owners);
+        for (int o = 0; o < ownerCount; ++o) {
+            int reader = owners[4 * o], seen = 0;
+            for (int p = 0; p < o; ++p)
+                seen |= owners[4 * p] == reader;
+            if (seen)
+                continue;
+            int pieceCount = windowPieces(mod(j->displs[reader] + shift, j->n), j->counts[reader], j->n, j->commSize, j->counts, j->displs, sendPieces);
+            for (int i = 0; i < pieceCount; ++i) {
+                int *piece = &sendPieces[4 * i];
+                if (piece[0] != j->myRank)
+                    continue;
+                int words = (piece[2] + 63) / 64;
+                memset(j->sendBits + sendAt, 0, (size_t) words * sizeof(uint64_t));
+                for (int b = 0; b < piece[2]; b += 64)
+                    orBits(j->sendBits + sendAt, b, readBits(j->current, j->words, piece[1] + b), piece[2] - b < 64 ? piece[2] - b : 64);
+                MPI_Isend(j->sendBits + sendAt, words, MPI_UINT64_T, reader, side, j->comm, &requests[requestCount++]);
+                sendAt += words;
+            }
+        }
+    }
+    MPI_Waitall(requestCount, requests, MPI_STATUSES_IGNORE);
+
+    recvAt = 0;
+    for (int side = 0; side < 2; ++side) {
+        memset(j->window[side], 0, (size_t) j->words * sizeof(uint64_t));
+        for (int i = 0; i < recvCount[side]; ++i) {
+            int *piece = &recvPieces[side][4 * i];
+            int words = (piece[2] + 63) / 64;
+            for (int b = 0; b < piece[2]; b += 64)
+                orBits(j->window[side], piece[3] + b, readBits(j->recvBits + recvAt, words, b), piece[2] - b < 64 ? piece[2] - b : 64);
+            recvAt += words;
+        }
+    }
+
+    for (int w = 0; w < j->words; ++w)
+        j->next[w] = (j->l & j->window[0][w]) ^ (j->c & j->current[w]) ^ (j->r & j->window[1][w]);
+    if (j->len % 64)
+        j->next[j->words - 1] &= ((uint64_t) 1 << (j->len % 64)) - 1;
+    uint64_t *swap = j->current;
+    j->current = j->next;
+    j->next = swap;
+}
+
+void jumpSlice(int t, int n, const int *counts, const int *displs, char *localConf, int ePP, MPI_Comm comm, int myRank, int commSize, const char *transFunc) {
+
+    // For a linear rule p(x) = l*x^-1 + c + r*x we have p(x)^(2^k) = l*x^-(2^k) + c + r*x^(2^k) mod 2, so
+    // generation t is reached by one shifted xor per set bit of t. Each rank only advances its own slice:
+    // O(ePP log t) work and O(log t) small messages instead of t halo exchanges.
+    SliceJump j;
+    j.n = n;
+    j.len = ePP;
+    j.words = (ePP + 63) / 64;
+    j.myRank = myRank;
+    j.commSize = commSize;
+    j.counts = counts;
+    j.displs = displs;
+    j.comm = comm;
+    j.l = transFunc[4] == '1' ? ~(uint64_t) 0 : 0;
+    j.c = transFunc[2] == '1' ? ~(uint64_t) 0 : 0;
+    j.r = transFunc[1] == '1' ? ~(uint64_t) 0 : 0;
+    j.current = calloc((unsigned int) j.words, sizeof(uint64_t));
+    j.next = calloc((unsigned int) j.words, sizeof(uint64_t));
+    j.window[0] = calloc((unsigned int) j.words, sizeof(uint64_t));
+    j.window[1] = calloc((unsigned int) j.words, sizeof(uint64_t));
+    j.sendBits = calloc((unsigned int) (2 * j.words + 2 * 3 * 3), sizeof(uint64_t)); // Each piece rounds up one word.
+    j.recvBits = calloc((unsigned int) (2 * j.words + 2 * 3), sizeof(uint64_t));
+
+    for (int x = 0; x < ePP; ++x)
+        j.current[x >> 6] |= (uint64_t) (localConf[x] - 48) << (x & 63);
+
+    int d = 1 % n;
+    for (; t > 0; t >>= 1) {
+        if (t & 1)
+            jumpRound(&j, d);
+        d = (2 * d) % n;
+    }
+
+    for (int x = 0; x < ePP; ++x)
+        localConf[x] = (char) (48 + ((j.current[x >> 6] >> (x & 63)) & 1));
+    free(j.current);
+    free(j.next);
+    free(j.window[0]);
+    free(j.window[1]);
+    free(j.sendBits);
+    free(j.recvBits);
+}
+
 void drawConfig(int n, const char *config) {
     for (int x = 0; x < n; ++x)
         (config[x] - 48) ? printf(" ") : printf("█");
     printf("\n");
 }
 
-void computeAndDraw(int t, int n, int ePP, char *rootConf, int myRank, int commSize, char *transFunc) {
+int countIntraNodeEdges(MPI_Comm comm, int nodeId) {
+
+    // Counts the ring edges myRank -> myRank + 1 whose two ends share a node; only valid on rank 0.
+    int myRank, commSize;
+    MPI_Comm_rank(comm, &myRank);
+    MPI_Comm_size(comm, &commSize);
+    int *nodes = malloc((unsigned long) commSize * sizeof(int));
+    MPI_Gather(&nodeId, 1, MPI_INT, nodes, 1, MPI_INT, 0, comm);
+    int intra = 0;
+    if (myRank == 0)
+        for (int r = 0; r < commSize; ++r)
+            intra += nodes[r] == nodes[mod(r + 1, commSize)];
+    free(nodes);
+    return intra;
+}
+
+MPI_Comm ringCommunicator() {
+
+#if TOPOLOGY_AWARE
+    int worldRank, worldSize;
+    MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+    MPI_Comm_size(MPI_COMM_WORLD, &worldSize);
+
+    // A node is named after its lowest world rank, which is rank 0 of its shared memory communicator.
+    MPI_Comm node;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, worldRank, MPI_INFO_NULL, &node);
+    int nodeId = worldRank;
+    MPI_Bcast(&nodeId, 1, MPI_INT, 0, node);
+    MPI_Comm_free(&node);
+
+    // Lay the ring out node by node, so only one edge per node leaves it, and let MPI reorder further.
+    MPI_Comm grouped, ring;
+    MPI_Comm_split(MPI_COMM_WORLD, 0, nodeId, &grouped);
+    int dims[1] = {worldSize};
+    int periods[1] = {1};
+    MPI_Cart_create(grouped, 1, dims, periods, 1, &ring);
+    MPI_Comm_free(&grouped);
+
+    int worldIntra = countIntraNodeEdges(MPI_COMM_WORLD, nodeId);
+    int ringIntra = countIntraNodeEdges(ring, nodeId);
+    if (worldRank == 0)
+        printf("Ring edges in MPI_COMM_WORLD order: %d intra-node, %d inter-node.\n", worldIntra, worldSize - worldIntra);
+    int ringRank;
+    MPI_Comm_rank(ring, &ringRank);
+    if (ringRank == 0)
+        printf("Ring edges in reordered order: %d intra-node, %d inter-node.\n", ringIntra, worldSize - ringIntra);
+    return ring;
+#else
+    return MPI_COMM_WORLD;
+#endif
+}
+
+void computeAndDraw(int t, int n, const int *counts, const int *displs, char *rootConf, MPI_Comm comm, int myRank, int commSize, char *transFunc) {
 
+    int ePP = counts[myRank];
     char *localConf = malloc((unsigned int) ePP * sizeof(char));
     char sendLeft, sendRight;
     char recvLeft, recvRight;
-    MPI_Scatter(rootConf, ePP, MPI_CHAR, localConf, ePP, MPI_CHAR, 0, MPI_COMM_WORLD);
+    long long stats[2];
+    MPI_Scatterv(rootConf, counts, displs, MPI_CHAR, localConf, ePP, MPI_CHAR, 0, comm);
 
     for (int i = 0; i < t; ++i) {
 
         sendLeft = localConf[0];
         sendRight = localConf[ePP - 1];
 
-        MPI_Send(&sendLeft, 1, MPI_CHAR, mod(myRank - 1, commSize), 0, MPI_COMM_WORLD);
-        MPI_Send(&sendRight, 1, MPI_CHAR, mod(myRank + 1, commSize), 0, MPI_COMM_WORLD);
+        MPI_Send(&sendLeft, 1, MPI_CHAR, mod(myRank - 1, commSize), 0, comm);
+        MPI_Send(&sendRight, 1, MPI_CHAR, mod(myRank + 1, commSize), 0, comm);
 
-        MPI_Recv(&recvRight, 1, MPI_CHAR, mod((myRank + 1), commSize), 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-        MPI_Recv(&recvLeft, 1, MPI_CHAR, mod((myRank - 1), commSize), 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        MPI_Recv(&recvRight, 1, MPI_CHAR, mod((myRank + 1), commSize), 0, comm, MPI_STATUS_IGNORE);
+        MPI_Recv(&recvLeft, 1, MPI_CHAR, mod((myRank - 1), commSize), 0, comm, MPI_STATUS_IGNORE);
 
-        stepConfig(ePP, &localConf, recvLeft, recvRight, transFunc);
+        stepConfig(ePP, &localConf, recvLeft, recvRight, transFunc, stats);
 
-        MPI_Gather(localConf, ePP, MPI_CHAR, rootConf, ePP, MPI_CHAR, 0, MPI_COMM_WORLD); // REVERSE of MPI_Scatter.
+        MPI_Gatherv(localConf, ePP, MPI_CHAR, rootConf, counts, displs, MPI_CHAR, 0, comm); // REVERSE of MPI_Scatterv.
         if (myRank == 0)
             drawConfig(n, rootConf);
     }
 }
 
-void compute(int t, int ePP, char *rootConf, int myRank, int commSize, char *transFunc) {
+void compute(int t, int n, const int *counts, const int *displs, char *rootConf, MPI_Comm comm, int myRank, int commSize, char *transFunc) {
 
+    int ePP = counts[myRank];
     char *localConf = malloc((unsigned int) ePP * sizeof(char));
     char sendLeft, sendRight;
     char recvLeft, recvRight;
+    long long stats[2][2]; // {population, changes}, double buffered while a reduction is in flight.
+#if STATISTICS
+    long long globalStats[2][2];
+    MPI_Request statsRequest = MPI_REQUEST_NULL;
+    FILE *series = myRank == 0 ? createFile(STATISTICS_FILE) : NULL;
+#endif
+
+    MPI_Scatterv(rootConf, counts, displs, MPI_CHAR, localConf, ePP, MPI_CHAR, 0, comm);
+
+    // The jump skips the intermediate generations, so it is only taken when no time series is recorded.
+    if (!STATISTICS && isLinearRule(transFunc)) {
+        jumpSlice(t, n, counts, displs, localConf, ePP, comm, myRank, commSize, transFunc);
+        t = 0;
+    }
 
-    MPI_Scatter(rootConf, ePP, MPI_CHAR, localConf, ePP, MPI_CHAR, 0, MPI_COMM_WORLD);
     for (int i = 0; i < t; ++i) {
 
         sendLeft = localConf[0];
         sendRight = localConf[ePP - 1];
 
-        MPI_Send(&sendLeft, 1, MPI_CHAR, mod(myRank - 1, commSize), 0, MPI_COMM_WORLD);
-        MPI_Send(&sendRight, 1, MPI_CHAR, mod(myRank + 1, commSize), 0, MPI_COMM_WORLD);
+        MPI_Send(&sendLeft, 1, MPI_CHAR, mod(myRank - 1, commSize), 0, comm);
+        MPI_Send(&sendRight, 1, MPI_CHAR, mod(myRank + 1, commSize), 0, comm);
 
-        MPI_Recv(&recvRight, 1, MPI_CHAR, mod((myRank + 1), commSize), 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-        MPI_Recv(&recvLeft, 1, MPI_CHAR, mod((myRank - 1), commSize), 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        MPI_Recv(&recvRight, 1, MPI_CHAR, mod((myRank + 1), commSize), 0, comm, MPI_STATUS_IGNORE);
+        MPI_Recv(&recvLeft, 1, MPI_CHAR, mod((myRank - 1), commSize), 0, comm, MPI_STATUS_IGNORE);
 
-        stepConfig(ePP, &localConf, recvLeft, recvRight, transFunc);
+        stepConfig(ePP, &localConf, recvLeft, recvRight, transFunc, stats[i % 2]);
+#if STATISTICS
+        // Finish the previous generation's reduction, which overlapped with this step, then start this one.
+        if (i > 0) {
+            MPI_Wait(&statsRequest, MPI_STATUS_IGNORE);
+            writeStatistics(series, i, n, globalStats[(i - 1) % 2]);
+        }
+        MPI_Iallreduce(stats[i % 2], globalStats[i % 2], 2, MPI_LONG_LONG, MPI_SUM, comm, &statsRequest);
+#endif
+    }
+#if STATISTICS
+    if (t > 0) {
+        MPI_Wait(&statsRequest, MPI_STATUS_IGNORE);
+        writeStatistics(series, t, n, globalStats[(t - 1) % 2]);
     }
-    MPI_Gather(localConf, ePP, MPI_CHAR, rootConf, ePP, MPI_CHAR, 0, MPI_COMM_WORLD); // REVERSE of MPI_Scatter.
+    if (series != NULL)
+        fclose(series);
+#endif
+    MPI_Gatherv(localConf, ePP, MPI_CHAR, rootConf, counts, displs, MPI_CHAR, 0, comm); // REVERSE of MPI_Scatterv.
 }
 
 int main(int argc, char **argv) {
@@ -185,22 +505,40 @@ int main(int argc, char **argv) {
     MPI_Init(&argc, &argv);
     int myRank;
     int commSize;
-    MPI_Comm_rank(MPI_COMM_WORLD, &myRank);
-    MPI_Comm_size(MPI_COMM_WORLD, &commSize);
+    MPI_Comm ring = ringCommunicator();
+    MPI_Comm_rank(ring, &myRank);
+    MPI_Comm_size(ring, &commSize);
 
-    int ePP = n / commSize; // elementsPerProcess
+    if (n < commSize) {
+        if (myRank == 0)
+            fprintf(stderr, "Need at least one cell per process, got n = %d for %d processes.\n", n, commSize);
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    int *counts = malloc((unsigned int) commSize * sizeof(int)); // elementsPerProcess
+    int *displs = malloc((unsigned int) commSize * sizeof(int));
+    splitRange(n, commSize, counts, displs);
     char *rootConf = malloc((unsigned int) n * sizeof(char));
 
     if (myRank == 0)
         readConfigState(confFile, n, rootConf);
 
-//    MPI_Barrier(MPI_COMM_WORLD); /* IMPORTANT */
+//    MPI_Barrier(ring); /* IMPORTANT */
 //    double start = MPI_Wtime();
-    compute(t, ePP, rootConf, myRank, commSize, transFunc);
-//    computeAndDraw(t, n, ePP, rootConf, myRank, commSize, transFunc);
-//    MPI_Barrier(MPI_COMM_WORLD); /* IMPORTANT */
+    compute(t, n, counts, displs, rootConf, ring, myRank, commSize, transFunc);
+//    computeAndDraw(t, n, counts, displs, rootConf, ring, myRank, commSize, transFunc);
+//    MPI_Barrier(ring); /* IMPORTANT */
 //    double end = MPI_Wtime();
 
+    if (myRank == 0 && argc == 5)
+        writeConfig(argv[4], n, rootConf);
+
+    free(counts);
+    free(displs);
+    free(rootConf);
+    if (ring != MPI_COMM_WORLD)
+        MPI_Comm_free(&ring);
     MPI_Finalize();
 
 
@@ -22,10 +22,11 @@ SOFTWARE.
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 void checkInput(int argc) {
-    if (argc != 4) {
-        fprintf(stderr, "Bad input. Expecting: {functionDefinition.txt} {initialConfiguration.txt} {t = time/turns}");
+    if (argc != 4 && argc != 5) {
+        fprintf(stderr, "Bad input. Expecting: {functionDefinition.txt} {initialConfiguration.txt} {t = time/turns} [finalConfiguration.txt]");
         exit(EXIT_FAILURE);
     }
 }
@@ -42,6 +43,14 @@ FILE *openFile(char *fileName) {
     } else return fp;
 }
 
+FILE *createFile(char *fileName) {
+    FILE *fp = fopen(fileName, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "Could not create %s.\n", fileName);
+        exit(EXIT_FAILURE);
+    } else return fp;
+}
+
 void setRange(char *function, char *fileName) {
 
     FILE *fp = openFile(fileName);
@@ -74,14 +83,25 @@ int readConfigLength(char *fileName) {
 void readConfigState(char *fileName, int len, char *config) {
 
     FILE *fp = openFile(fileName);
+    char header[32]; // The line holding n, read on its own so it is consumed whatever its length.
     char temp[len + 1];
-    fgets(temp, len + 1, fp);
-    fgets(temp, len + 1, fp);
+    if (fgets(header, sizeof(header), fp) == NULL || fgets(temp, len + 1, fp) == NULL) {
+        fprintf(stderr, "Bad configuration file, could not read %d cells.", len);
+        exit(EXIT_FAILURE);
+    }
     for (int i = 0; i < len; ++i)
         config[i] = temp[i];
     fclose(fp);
 }
 
+void writeConfig(char *fileName, int len, const char *config) {
+
+    // Same format as the initial configuration, so every variant's final state can be compared with cmp.
+    FILE *fp = createFile(fileName);
+    fprintf(fp, "%d\n%.*s\n", len, len, config);
+    fclose(fp);
+}
+
 void *stepConfig(int n, char **config, const char *transFunc) {
 
     char *current = *config;
@@ -98,6 +118,65 @@ void *stepConfig(int n, char **config, const char *transFunc) {
     *config = next;
 }
 
+int isLinearRule(const char *transFunc) {
+    // Additive rules satisfy f(abc) = a*f(100) ^ b*f(010) ^ c*f(001) over GF(2), e.g. 60, 90, 102 and 150.
+    int l = transFunc[4] - 48, c = transFunc[2] - 48, r = transFunc[1] - 48;
+    for (int i = 0; i < 8; ++i)
+        if (transFunc[i] - 48 != ((l & (i >> 2)) ^ (c & (i >> 1)) ^ (r & i)))
+            return 0;
+    return 1;
+}
+
+uint64_t ringBits(const uint64_t *ring, int n, int pos) {
+    // Returns the 64 cells starting at bit pos of the cyclic ring, cell pos in the lowest bit.
+    if (pos + 64 <= n) {
+        int w = pos >> 6, s = pos & 63;
+        return s ? (ring[w] >> s) | (ring[w + 1] << (64 - s)) : ring[w];
+    }
+    uint64_t bits = 0;
+    for (int b = 0; b < 64; ++b) {
+        int x = (pos + b) % n;
+        bits |= ((ring[x >> 6] >> (x & 63)) & 1) << b;
+    }
+    return bits;
+}
+
+void jumpConfig(int n, char *config, int t, const char *transFunc) {
+
+    // For a linear rule p(x) = l*x^-1 + c + r*x we have p(x)^(2^k) = l*x^-(2^k) + c + r*x^(2^k) mod 2,
+    // so generation t is reached by one shifted xor per set bit of t: O(n log t) instead of O(n t).
+    int words = (n + 63) / 64;
+    uint64_t lastMask = (n % 64) ? ((uint64_t) 1 << (n % 64)) - 1 : ~(uint64_t) 0;
+    uint64_t l = transFunc[4] == '1' ? ~(uint64_t) 0 : 0;
+    uint64_t c = transFunc[2] == '1' ? ~(uint64_t) 0 : 0;
+    uint64_t r = transFunc[1] == '1' ? ~(uint64_t) 0 : 0;
+
+    uint64_t *current = calloc((unsigned int) words, sizeof(uint64_t));
+    uint64_t *next = calloc((unsigned int) words, sizeof(uint64_t));
+    for (int x = 0; x < n; ++x)
+        current[x >> 6] |= (uint64_t) (config[x] - 48) << (x & 63);
+
+    int d = 1 % n;
+    for (; t > 0; t >>= 1) {
+        if (t & 1) {
+            for (int w = 0; w < words; ++w)
+                next[w] = (l & ringBits(current, n, mod(64 * w - d, n))) ^
+                          (c & current[w]) ^
+                          (r & ringBits(current, n, mod(64 * w + d, n)));
+            next[words - 1] &= lastMask;
+            uint64_t *swap = current;
+            current = next;
+            next = swap;
+        }
+        d = (2 * d) % n;
+    }
+
+    for (int x = 0; x < n; ++x)
+        config[x] = (char) (48 + ((current[x >> 6] >> (x & 63)) & 1));
+    free(current);
+    free(next);
+}
+
 void drawConfig(int n, const char *config) {
     for (int x = 0; x < n; ++x)
         (config[x] - 48) ? printf(" ") : printf("█");
@@ -120,9 +199,16 @@ int main(int argc, char **argv) {
     readConfigState(confFile, n, config);
 
     drawConfig(n, config);
+    if (isLinearRule(transFunc)) {
+        jumpConfig(n, config, t, transFunc);
+        drawConfig(n, config);
+        t = 0;
+    }
     for (int i = 0; i < t; ++i) {
         stepConfig(n, &config, transFunc);
         drawConfig(n, config);
     }
+    if (argc == 5)
+        writeConfig(argv[4], n, config);
     printf("\nEnd\n");
 }
@@ -26,10 +26,27 @@ SOFTWARE.
 #include <unistd.h>
 #include <time.h>
 #include <mpi.h>
+#include <string.h>
+#include <sys/ioctl.h>
+
+#ifndef TOPOLOGY_AWARE
+#define TOPOLOGY_AWARE 0 // Reorder ranks so ring neighbours share a node where possible.
+#endif
+#ifndef RUN_LENGTH_HALOS
+#define RUN_LENGTH_HALOS 1 // Send a boundary run-length encoded whenever that is smaller than bit-packed.
+#endif
+#ifndef STATISTICS
+#define STATISTICS 0 // Write population and change counts of every generation to STATISTICS_FILE.
+#endif
+#ifndef STATISTICS_FILE
+#define STATISTICS_FILE "statistics.txt"
+#endif
+
+enum { HALO_PACKED = 0, HALO_RUN_LENGTH = 1 }; // First byte of every halo message.
 
 void checkInput(int argc) {
-    if (argc != 4) {
-        fprintf(stderr, "Bad input. Expecting: {functionDefinition.txt} {initialConfiguration.txt} {t = time/turns}");
+    if (argc != 4 && argc != 5) {
+        fprintf(stderr, "Bad input. Expecting: {functionDefinition.txt} {initialConfiguration.txt} {t = time/turns} [finalConfiguration.txt]");
         exit(EXIT_FAILURE);
     }
 }
@@ -46,6 +63,14 @@ FILE *openFile(char *fileName) {
     } else return fp;
 }
 
+FILE *createFile(char *fileName) {
+    FILE *fp = fopen(fileName, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "Could not create %s.\n", fileName);
+        exit(EXIT_FAILURE);
+    } else return fp;
+}
+
 void setFunctionRange(char *fileName, char *function) {
 
     FILE *fp = openFile(fileName);
@@ -89,7 +114,7 @@ void setInitialConfiguration(int n, char ***configuration, char *configurationFi
 
     char **temp = calloc((unsigned long)n , sizeof(char *));
     for(int i = 0; i < n; i++)
-        temp[i] = calloc((unsigned long)n , sizeof(char));
+        temp[i] = calloc((unsigned long)n + 2, sizeof(char)); // Room for the newline and terminator fgets() stores.
 
     if (!temp) {
         fprintf(stderr, "NULL POINTER AT ALLOC:%d.\n", __LINE__);
@@ -110,10 +135,40 @@ void setInitialConfiguration(int n, char ***configuration, char *configurationFi
     fclose(fp);
 }
 
-void stepConfigurationOnce(int n, int ePP, char **currentBuffer, char **aggregateBuffer, const char transformationFunction[512]) {
+void writeConfiguration(char *fileName, int n, char **configuration) {
+
+    // Same format as the initial configuration, so every variant's final state can be compared with cmp.
+    FILE *fp = createFile(fileName);
+    fprintf(fp, "%d\n", n);
+    for (int x = 0; x < n; ++x)
+        fprintf(fp, "%.*s\n", n, configuration[x]);
+    fclose(fp);
+}
+
+void writeStatistics(FILE *fp, int generation, long long cells, const long long *stats) {
+    // One line per generation: generation, population, cells changed since the previous one, density.
+    if (fp != NULL)
+        fprintf(fp, "%d %lld %lld %.6f\n", generation, stats[0], stats[1], (double) stats[0] / (double) cells);
+}
+
+void splitRange(int n, int commSize, int *counts, int *displs) {
+
+    // The n % commSize leftover columns go one each to the first ranks, so no column is dropped.
+    for (int r = 0; r < commSize; ++r) {
+        counts[r] = n / commSize + (r < n % commSize);
+        displs[r] = r ? displs[r - 1] + counts[r - 1] : 0;
+    }
+}
+
+void stepConfigurationOnce(int n, int ePP, char **currentBuffer, char **aggregateBuffer, const char transformationFunction[512], long long *stats) {
 
     int aggX = n+2;
     int aggY = ePP+2;
+#if STATISTICS
+    stats[0] = stats[1] = 0; // Population and changed cells of the new generation, counted while it is written.
+#else
+    (void) stats;
+#endif
 
     for (int x = 1; x < aggX-1; ++x) {
         for (int y = 1; y < aggY-1; ++y) {
@@ -124,33 +179,151 @@ void stepConfigurationOnce(int n, int ePP, char **currentBuffer, char **aggregat
 
                     4*(aggregateBuffer[x+1][y-1]-48) + 2*(aggregateBuffer[x+1][y]-48) + (aggregateBuffer[x+1][y+1]-48)
             ];
+#if STATISTICS
+            stats[0] += currentBuffer[x-1][y-1] - 48;
+            stats[1] += currentBuffer[x-1][y-1] != aggregateBuffer[x][y];
+#endif
+        }
+    }
+}
+
+typedef struct {
+    int rows, cols;   // Size of the frame on screen.
+    int scale;        // Cells per character along each axis, > 1 when the grid is larger than the terminal.
+    char *frame;      // Frame being built.
+    char *shown;      // Frame currently on screen, NULL until the first draw.
+    char *out;        // Escape sequences for one frame, written with a single fwrite().
+} Renderer;
+
+void initRenderer(Renderer *renderer, int n) {
+
+    int termRows = 24, termCols = 80;
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 1 && ws.ws_col > 0) {
+        termRows = ws.ws_row;
+        termCols = ws.ws_col;
+    }
+    termRows--; // Keep the last line free so the screen does not scroll.
+
+    renderer->scale = 1;
+    while ((n + renderer->scale - 1) / renderer->scale > termRows || (n + renderer->scale - 1) / renderer->scale > termCols)
+        renderer->scale++;
+    renderer->rows = (n + renderer->scale - 1) / renderer->scale;
+    renderer->cols = renderer->rows;
+
+    size_t cells = (size_t) renderer->rows * (size_t) renderer->cols;
+    renderer->frame = malloc(cells);
+    renderer->shown = NULL;
+    renderer->out = malloc(cells * 16 + 16); // Worst case: a cursor move before every cell.
+    if (!renderer->frame || !renderer->out) {
+        fprintf(stderr, "NULL POINTER AT ALLOC:%d.\n", __LINE__);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void freeRenderer(Renderer *renderer) {
+    free(renderer->frame);
+    free(renderer->shown);
+    free(renderer->out);
+}
+
+void drawConfiguration(Renderer *renderer, int n, char **configuration) {
+
+    int scale = renderer->scale;
+    for (int r = 0; r < renderer->rows; ++r) {
+        for (int c = 0; c < renderer->cols; ++c) {
+            char alive = 0; // A downsampled character is lit when any cell in its block is alive.
+            for (int x = r * scale; x < (r + 1) * scale && x < n && !alive; ++x)
+                for (int y = c * scale; y < (c + 1) * scale && y < n && !alive; ++y)
+                    alive = (char) (configuration[x][y] - 48);
+            renderer->frame[r * renderer->cols + c] = alive ? '*' : ' ';
+        }
+    }
+
+    char *out = renderer->out;
+    int full = renderer->shown == NULL;
+    if (full) {
+        renderer->shown = malloc((size_t) renderer->rows * (size_t) renderer->cols);
+        out += sprintf(out, "\033[2J"); // Clean the screen once, later frames only patch changed cells.
+    }
+    for (int r = 0; r < renderer->rows; ++r) {
+        int cursor = -1; // Column the terminal cursor sits at on this row, -1 when unknown.
+        for (int c = 0; c < renderer->cols; ++c) {
+            int i = r * renderer->cols + c;
+            if (!full && renderer->frame[i] == renderer->shown[i])
+                continue;
+            if (cursor != c)
+                out += sprintf(out, "\033[%d;%dH", r + 1, c + 1);
+            *out++ = renderer->frame[i];
+            cursor = c + 1;
         }
     }
+    out += sprintf(out, "\033[%d;1H", renderer->rows + 1); // Park the cursor below the frame.
+    fwrite(renderer->out, 1, (size_t) (out - renderer->out), stdout);
+    fflush(stdout);
+    memcpy(renderer->shown, renderer->frame, (size_t) renderer->rows * (size_t) renderer->cols);
 }
 
-void drawConfiguration(int n, char **configuration) {
+int haloCapacity(int n) {
+    return 1 + (n + 7) / 8;
+}
 
-    for (int x = 0; x < n; ++x) {
-        if ( x != 0 )
-            printf("\n");
-        for (int y = 0; y < n; ++y)
-            (configuration[x][y] - 48) ? printf("*") : printf(" ");
+int packHalo(int n, char **buffer, int column, unsigned char *halo) {
+
+    int packedBytes = (n + 7) / 8;
+#if RUN_LENGTH_HALOS
+    // Runs alternate dead/alive starting with dead, each length stored as a 7-bit varint.
+    int len = 1;
+    char value = '0';
+    for (int x = 0; x < n && len <= packedBytes; value = (char) (value == '0' ? '1' : '0')) {
+        int run = 0;
+        while (x < n && buffer[x][column] == value) {
+            run++;
+            x++;
+        }
+        for (; run > 0x7F && len <= packedBytes; run >>= 7)
+            halo[len++] = (unsigned char) (0x80 | (run & 0x7F));
+        if (len <= packedBytes)
+            halo[len++] = (unsigned char) run;
+    }
+    if (len <= packedBytes) {
+        halo[0] = HALO_RUN_LENGTH;
+        return len;
     }
-    printf("\n");
-    printf("\033[2J");   // Clean the screen
-    printf("\033[1;1H"); // Set the cursor to 1:1 position
+#endif
+    halo[0] = HALO_PACKED;
+    memset(halo + 1, 0, (size_t) packedBytes);
+    for (int x = 0; x < n; ++x)
+        halo[1 + (x >> 3)] |= (unsigned char) ((buffer[x][column] - 48) << (x & 7));
+    return 1 + packedBytes;
 }
 
-void mergeAggregate(int n, int ePP, char **localBuffer, const char *left, const char *right, char **aggregate){
+void unpackHalo(int n, const unsigned char *halo, char **aggregate, int column) {
+
+    if (halo[0] == HALO_RUN_LENGTH) {
+        char value = '0';
+        int pos = 1;
+        for (int x = 0; x < n; value = (char) (value == '0' ? '1' : '0')) {
+            int run = 0, shift = 0;
+            do {
+                run |= (halo[pos] & 0x7F) << shift;
+                shift += 7;
+            } while (halo[pos++] & 0x80);
+            for (; run > 0 && x < n; --run)
+                aggregate[1 + x++][column] = value;
+        }
+    } else {
+        for (int x = 0; x < n; ++x)
+            aggregate[1 + x][column] = (char) (48 + ((halo[1 + (x >> 3)] >> (x & 7)) & 1));
+    }
+}
 
+void mergeAggregate(int n, int ePP, char **localBuffer, char **aggregate){
+
+    // The ghost columns 0 and aggY-1 have already been filled by unpackHalo().
     int aggX = n+2;
     int aggY = ePP+2;
 
-    for (int sidesX = 1; sidesX < aggX-1; ++sidesX) {
-        aggregate[sidesX][0] = left[sidesX-1];
-        aggregate[sidesX][aggY-1] = right[sidesX-1];
-    }
-
     for (int coreX = 1; coreX < aggX-1; ++coreX) {
         for (int coreY = 1; coreY < aggY - 1; ++coreY) {
             aggregate[coreX][coreY] = localBuffer[coreX-1][coreY-1];
@@ -163,12 +336,74 @@ void mergeAggregate(int n, int ePP, char **localBuffer, const char *left, const
     }
 }
 
-void compute(int n, int t, int ePP, char **rootConfiguration, int myRank, int commSize, const char *transformationFunction) {
+int countIntraNodeEdges(MPI_Comm comm, int nodeId) {
+
+    // Counts the ring edges myRank -> myRank + 1 whose two ends share a node; only valid on rank 0.
+    int myRank, commSize;
+    MPI_Comm_rank(comm, &myRank);
+    MPI_Comm_size(comm, &commSize);
+    int *nodes = malloc((unsigned long) commSize * sizeof(int));
+    MPI_Gather(&nodeId, 1, MPI_INT, nodes, 1, MPI_INT, 0, comm);
+    int intra = 0;
+    if (myRank == 0)
+        for (int r = 0; r < commSize; ++r)
+            intra += nodes[r] == nodes[mod(r + 1, commSize)];
+    free(nodes);
+    return intra;
+}
 
-    char sendLeft[n], sendRight[n];
-    char recvLeft[n], recvRight[n];
+MPI_Comm ringCommunicator() {
+
+#if TOPOLOGY_AWARE
+    int worldRank, worldSize;
+    MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+    MPI_Comm_size(MPI_COMM_WORLD, &worldSize);
+
+    // A node is named after its lowest world rank, which is rank 0 of its shared memory communicator.
+    MPI_Comm node;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, worldRank, MPI_INFO_NULL, &node);
+    int nodeId = worldRank;
+    MPI_Bcast(&nodeId, 1, MPI_INT, 0, node);
+    MPI_Comm_free(&node);
+
+    // Lay the ring out node by node, so only one edge per node leaves it, and let MPI reorder further.
+    MPI_Comm grouped, ring;
+    MPI_Comm_split(MPI_COMM_WORLD, 0, nodeId, &grouped);
+    int dims[1] = {worldSize};
+    int periods[1] = {1};
+    MPI_Cart_create(grouped, 1, dims, periods, 1, &ring);
+    MPI_Comm_free(&grouped);
+
+    int worldIntra = countIntraNodeEdges(MPI_COMM_WORLD, nodeId);
+    int ringIntra = countIntraNodeEdges(ring, nodeId);
+    if (worldRank == 0)
+        printf("Ring edges in MPI_COMM_WORLD order: %d intra-node, %d inter-node.\n", worldIntra, worldSize - worldIntra);
+    int ringRank;
+    MPI_Comm_rank(ring, &ringRank);
+    if (ringRank == 0)
+        printf("Ring edges in reordered order: %d intra-node, %d inter-node.\n", ringIntra, worldSize - ringIntra);
+    return ring;
+#else
+    return MPI_COMM_WORLD;
+#endif
+}
 
-    MPI_Request req;
+void compute(int n, int t, const int *counts, const int *displs, char **rootConfiguration, MPI_Comm comm, int myRank, int commSize, const char *transformationFunction) {
+
+    int ePP = counts[myRank];
+
+    int haloBytes = haloCapacity(n);
+    unsigned char sendLeft[haloBytes], sendRight[haloBytes];
+    unsigned char recvLeft[haloBytes], recvRight[haloBytes];
+    long long wireBytes = 0;
+    long long stats[2][2]; // {population, changes}, double buffered while a reduction is in flight.
+#if STATISTICS
+    long long globalStats[2][2];
+    MPI_Request statsRequest = MPI_REQUEST_NULL;
+    FILE *series = myRank == 0 ? createFile(STATISTICS_FILE) : NULL;
+#endif
+
+    MPI_Request req[2];
 
     char **currentBuffer = malloc((unsigned long) n * sizeof(char *));
     for (int i = 0; i < n; ++i) {
@@ -180,38 +415,66 @@ void compute(int n, int t, int ePP, char **rootConfiguration, int myRank, int co
         aggregateBuffer[i] = malloc((unsigned long) (ePP+2) * sizeof(char));
 
     for (int k = 0; k < n; ++k)
-        MPI_Scatter(rootConfiguration[k], ePP, MPI_CHAR, currentBuffer[k], ePP, MPI_CHAR, 0, MPI_COMM_WORLD);
+        MPI_Scatterv(rootConfiguration[k], counts, displs, MPI_CHAR, currentBuffer[k], ePP, MPI_CHAR, 0, comm);
+
+//    Renderer renderer;
+//    if ( myRank == 0 )
+//        initRenderer(&renderer, n);
 
     for (int i = 0; i < t; ++i) {
 
 //        if ( myRank == 0 )
-//            drawConfiguration(n, rootConfiguration);
+//            drawConfiguration(&renderer, n, rootConfiguration);
 //        for (int k = 0; k < n; ++k)
-//            MPI_Scatter(rootConfiguration[k], ePP, MPI_CHAR, currentBuffer[k], ePP, MPI_CHAR, 0, MPI_COMM_WORLD);
+//            MPI_Scatterv(rootConfiguration[k], counts, displs, MPI_CHAR, currentBuffer[k], ePP, MPI_CHAR, 0, comm);
 
-        for (int li = 0; li < n; ++li)
-            sendLeft[li] = currentBuffer[li][0];
+        int leftBytes = packHalo(n, currentBuffer, 0, sendLeft);
+        int rightBytes = packHalo(n, currentBuffer, ePP-1, sendRight);
+        wireBytes += leftBytes + rightBytes;
 
-        for (int ri = 0; ri < n; ++ri)
-            sendRight[ri] = currentBuffer[ri][ePP-1];
+        MPI_Isend(sendLeft, leftBytes, MPI_UNSIGNED_CHAR, mod(myRank - 1, commSize), 1, comm, &req[0]);
+        MPI_Isend(sendRight, rightBytes, MPI_UNSIGNED_CHAR, mod(myRank + 1, commSize), 2, comm, &req[1]);
 
-        MPI_Isend(&sendLeft, n, MPI_CHAR, mod(myRank - 1, commSize), 1, MPI_COMM_WORLD, &req);
-        MPI_Isend(&sendRight, n, MPI_CHAR, mod(myRank + 1, commSize), 2, MPI_COMM_WORLD, &req);
+        MPI_Recv(recvRight, haloBytes, MPI_UNSIGNED_CHAR, mod((myRank + 1), commSize), 1, comm, MPI_STATUS_IGNORE);
+        MPI_Recv(recvLeft, haloBytes, MPI_UNSIGNED_CHAR, mod((myRank - 1), commSize), 2, comm, MPI_STATUS_IGNORE);
 
-        MPI_Recv(&recvRight, n, MPI_CHAR, mod((myRank + 1), commSize), 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-        MPI_Recv(&recvLeft, n, MPI_CHAR, mod((myRank - 1), commSize), 2, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        unpackHalo(n, recvLeft, aggregateBuffer, 0);
+        unpackHalo(n, recvRight, aggregateBuffer, ePP+1);
+        mergeAggregate(n, ePP, currentBuffer, aggregateBuffer);
+        MPI_Waitall(2, req, MPI_STATUSES_IGNORE); // Send buffers are repacked next generation.
 
-        mergeAggregate(n, ePP, currentBuffer, recvLeft, recvRight, aggregateBuffer);
-
-        stepConfigurationOnce(n, ePP, currentBuffer, aggregateBuffer, transformationFunction);
+        stepConfigurationOnce(n, ePP, currentBuffer, aggregateBuffer, transformationFunction, stats[i % 2]);
+#if STATISTICS
+        // Finish the previous generation's reduction, which overlapped with this step, then start this one.
+        if (i > 0) {
+            MPI_Wait(&statsRequest, MPI_STATUS_IGNORE);
+            writeStatistics(series, i, (long long) n * n, globalStats[(i - 1) % 2]);
+        }
+        MPI_Iallreduce(stats[i % 2], globalStats[i % 2], 2, MPI_LONG_LONG, MPI_SUM, comm, &statsRequest);
+#endif
 
 //        for (int k = 0; k < n; ++k)
-//            MPI_Gather(currentBuffer[k], ePP, MPI_CHAR, rootConfiguration[k], ePP, MPI_CHAR, 0, MPI_COMM_WORLD);
+//            MPI_Gatherv(currentBuffer[k], ePP, MPI_CHAR, rootConfiguration[k], counts, displs, MPI_CHAR, 0, comm);
 //        usleep(100000);
     }
 
     for (int k = 0; k < n; ++k)
-        MPI_Gather(currentBuffer[k], ePP, MPI_CHAR, rootConfiguration[k], ePP, MPI_CHAR, 0, MPI_COMM_WORLD);
+        MPI_Gatherv(currentBuffer[k], ePP, MPI_CHAR, rootConfiguration[k], counts, displs, MPI_CHAR, 0, comm);
+
+#if STATISTICS
+    if (t > 0) {
+        MPI_Wait(&statsRequest, MPI_STATUS_IGNORE);
+        writeStatistics(series, t, (long long) n * n, globalStats[(t - 1) % 2]);
+    }
+    if (series != NULL)
+        fclose(series);
+#endif
+
+    long long totalWireBytes = 0;
+    MPI_Reduce(&wireBytes, &totalWireBytes, 1, MPI_LONG_LONG, MPI_SUM, 0, comm);
+    if (myRank == 0 && t > 0)
+        printf("Halo bytes on the wire per step: %.1f (ASCII halos: %d)\n",
+               (double) totalWireBytes / t, 2 * n * commSize);
 
     for (int l = 0; l < n + 2; ++l)
         free(aggregateBuffer[l]);
@@ -227,8 +490,9 @@ int main(int argc, char **argv) {
     MPI_Init(&argc, &argv);
     int myRank;
     int commSize;
-    MPI_Comm_rank(MPI_COMM_WORLD, &myRank);
-    MPI_Comm_size(MPI_COMM_WORLD, &commSize);
+    MPI_Comm ring = ringCommunicator();
+    MPI_Comm_rank(ring, &myRank);
+    MPI_Comm_size(ring, &commSize);
 
     char *functionFile = argv[1];
     char *configurationFile = argv[2];
@@ -237,7 +501,17 @@ int main(int argc, char **argv) {
     char transformationFunction[512];
     setFunctionRange(functionFile, transformationFunction);
     char **rootConfiguration = NULL;
-    int ePP = n / commSize; // elementsPerProcess
+
+    if (n < commSize) {
+        if (myRank == 0)
+            fprintf(stderr, "Need at least one column per process, got n = %d for %d processes.\n", n, commSize);
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    int *counts = malloc((unsigned long) commSize * sizeof(int)); // elementsPerProcess
+    int *displs = malloc((unsigned long) commSize * sizeof(int));
+    splitRange(n, commSize, counts, displs);
 
     if ( myRank == 0 ) {
         checkInput(argc);
@@ -246,21 +520,28 @@ int main(int argc, char **argv) {
         rootConfiguration = malloc(sizeof(char *));
     }
 
-//    MPI_Barrier(MPI_COMM_WORLD); /* IMPORTANT */
+//    MPI_Barrier(ring); /* IMPORTANT */
 //    double start = MPI_Wtime();
 
-    compute(n, t, ePP, rootConfiguration, myRank, commSize, transformationFunction);
+    compute(n, t, counts, displs, rootConfiguration, ring, myRank, commSize, transformationFunction);
 
-//    MPI_Barrier(MPI_COMM_WORLD); /* IMPORTANT */
+//    MPI_Barrier(ring); /* IMPORTANT */
 //    double end = MPI_Wtime();
 
 
+    if ( myRank == 0 && argc == 5 )
+        writeConfiguration(argv[4], n, rootConfiguration);
+
     if ( myRank == 0 )
         for (int j = 0; j < n; ++j)
             free(rootConfiguration[j]);
 
     free(rootConfiguration);
+    free(counts);
+    free(displs);
 
+    if (ring != MPI_COMM_WORLD)
+        MPI_Comm_free(&ring);
     MPI_Finalize();
 
 //    if (myRank == 0) {
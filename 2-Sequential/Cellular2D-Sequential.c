@@ -25,10 +25,19 @@ SOFTWARE.
 #include <math.h>
 #include <unistd.h>
 #include <time.h>
+#include <string.h>
+#include <sys/ioctl.h>
+
+#ifndef FRAMES_PER_SECOND
+#define FRAMES_PER_SECOND 10
+#endif
+#ifndef GENERATIONS_PER_SECOND
+#define GENERATIONS_PER_SECOND 0 // 0 runs the simulation unthrottled, frames are then skipped to keep up.
+#endif
 
 void checkInput(int argc) {
-    if (argc != 4) {
-        fprintf(stderr, "Bad input. Expecting: {functionDefinition.txt} {initialConfiguration.txt} {t = time/turns}");
+    if (argc != 4 && argc != 5) {
+        fprintf(stderr, "Bad input. Expecting: {functionDefinition.txt} {initialConfiguration.txt} {t = time/turns} [finalConfiguration.txt]");
         exit(EXIT_FAILURE);
     }
 }
@@ -45,6 +54,14 @@ FILE *openFile(char *fileName) {
     } else return fp;
 }
 
+FILE *createFile(char *fileName) {
+    FILE *fp = fopen(fileName, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "Could not create %s.\n", fileName);
+        exit(EXIT_FAILURE);
+    } else return fp;
+}
+
 void setFunctionRange(char *fileName, char *function) {
 
     FILE *fp = openFile(fileName);
@@ -86,18 +103,30 @@ void setInitialConfiguration(int n, char configuration[n][n], char *configuratio
         exit(EXIT_FAILURE);
     }
 
+    char row[n + 2]; // Rows are read with their newline and terminator, which do not fit in configuration[x].
     int rowCounter = 0;
     while (rowCounter < n) {
-        if (fgets(configuration[rowCounter], n + 2, fp) == NULL) {
+        if (fgets(row, n + 2, fp) == NULL) {
             fprintf(stderr, "Bad fgets() @ line:%d.\n", __LINE__);
             fprintf(stderr, "Config file should be %d lines long, %d were read .", n, rowCounter);
             exit(EXIT_FAILURE);
         }
+        memcpy(configuration[rowCounter], row, (size_t) n);
         rowCounter++;
     }
     fclose(fp);
 }
 
+void writeConfiguration(char *fileName, int n, char configuration[n][n]) {
+
+    // Same format as the initial configuration, so every variant's final state can be compared with cmp.
+    FILE *fp = createFile(fileName);
+    fprintf(fp, "%d\n", n);
+    for (int x = 0; x < n; ++x)
+        fprintf(fp, "%.*s\n", n, configuration[x]);
+    fclose(fp);
+}
+
 void copy2D(int n, char first[n][n], char second[n][n]) {
     for (int i = 0; i < n; ++i)
         for (int j = 0; j < n; ++j)
@@ -132,17 +161,87 @@ void stepConfigurationOnce(int n, char currentConfiguration[n][n], char oldBuffe
     }
 }
 
-void drawConfiguration(int n, char configuration[n][n]) {
+typedef struct {
+    int rows, cols;   // Size of the frame on screen.
+    int scale;        // Cells per character along each axis, > 1 when the grid is larger than the terminal.
+    char *frame;      // Frame being built.
+    char *shown;      // Frame currently on screen, NULL until the first draw.
+    char *out;        // Escape sequences for one frame, written with a single fwrite().
+} Renderer;
+
+double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
 
-    for (int x = 0; x < n; ++x) {
-        if ( x != 0 )
-            printf("\n");
-        for (int y = 0; y < n; ++y)
-            (configuration[x][y] - 48) ? printf("*") : printf(" ");
+void initRenderer(Renderer *renderer, int n) {
+
+    int termRows = 24, termCols = 80;
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 1 && ws.ws_col > 0) {
+        termRows = ws.ws_row;
+        termCols = ws.ws_col;
+    }
+    termRows--; // Keep the last line free so the screen does not scroll.
+
+    renderer->scale = 1;
+    while ((n + renderer->scale - 1) / renderer->scale > termRows || (n + renderer->scale - 1) / renderer->scale > termCols)
+        renderer->scale++;
+    renderer->rows = (n + renderer->scale - 1) / renderer->scale;
+    renderer->cols = renderer->rows;
+
+    size_t cells = (size_t) renderer->rows * (size_t) renderer->cols;
+    renderer->frame = malloc(cells);
+    renderer->shown = NULL;
+    renderer->out = malloc(cells * 16 + 16); // Worst case: a cursor move before every cell.
+    if (!renderer->frame || !renderer->out) {
+        fprintf(stderr, "NULL POINTER AT ALLOC:%d.\n", __LINE__);
+        exit(EXIT_FAILURE);
     }
-    printf("\n");
-    printf("\033[2J");   // Clean the screen
-    printf("\033[1;1H"); // Set the cursor to 1:1 position
+}
+
+void freeRenderer(Renderer *renderer) {
+    free(renderer->frame);
+    free(renderer->shown);
+    free(renderer->out);
+}
+
+void drawConfiguration(Renderer *renderer, int n, char configuration[n][n]) {
+
+    int scale = renderer->scale;
+    for (int r = 0; r < renderer->rows; ++r) {
+        for (int c = 0; c < renderer->cols; ++c) {
+            char alive = 0; // A downsampled character is lit when any cell in its block is alive.
+            for (int x = r * scale; x < (r + 1) * scale && x < n && !alive; ++x)
+                for (int y = c * scale; y < (c + 1) * scale && y < n && !alive; ++y)
+                    alive = (char) (configuration[x][y] - 48);
+            renderer->frame[r * renderer->cols + c] = alive ? '*' : ' ';
+        }
+    }
+
+    char *out = renderer->out;
+    int full = renderer->shown == NULL;
+    if (full) {
+        renderer->shown = malloc((size_t) renderer->rows * (size_t) renderer->cols);
+        out += sprintf(out, "\033[2J"); // Clean the screen once, later frames only patch changed cells.
+    }
+    for (int r = 0; r < renderer->rows; ++r) {
+        int cursor = -1; // Column the terminal cursor sits at on this row, -1 when unknown.
+        for (int c = 0; c < renderer->cols; ++c) {
+            int i = r * renderer->cols + c;
+            if (!full && renderer->frame[i] == renderer->shown[i])
+                continue;
+            if (cursor != c)
+                out += sprintf(out, "\033[%d;%dH", r + 1, c + 1);
+            *out++ = renderer->frame[i];
+            cursor = c + 1;
+        }
+    }
+    out += sprintf(out, "\033[%d;1H", renderer->rows + 1); // Park the cursor below the frame.
+    fwrite(renderer->out, 1, (size_t) (out - renderer->out), stdout);
+    fflush(stdout);
+    memcpy(renderer->shown, renderer->frame, (size_t) renderer->rows * (size_t) renderer->cols);
 }
 
 int main(int argc, char **argv) {
@@ -163,11 +262,37 @@ int main(int argc, char **argv) {
 
 
 //    clock_t start = clock(), diff;
+    Renderer renderer;
+    initRenderer(&renderer, n);
+    double framePeriod = 1.0 / FRAMES_PER_SECOND;
+    double generationPeriod = GENERATIONS_PER_SECOND ? 1.0 / GENERATIONS_PER_SECOND : 0.0;
+    double nextFrame = now();
+    double nextGeneration = nextFrame;
+
     for (int i = 0; i < t; ++i) {
         stepConfigurationOnce(n, configuration, previousConfiguration, transformationFunction);
-        drawConfiguration(n, configuration);
-        usleep(100000);
+
+        double current = now();
+        if (current >= nextFrame) {
+            drawConfiguration(&renderer, n, configuration);
+            nextFrame += framePeriod;
+            if (nextFrame < current) // Display fell behind, skip the missed frames instead of catching up.
+                nextFrame = current + framePeriod;
+        }
+
+        // Sleep only for what is left of the generation period, the step itself already took some of it.
+        nextGeneration += generationPeriod;
+        double ahead = nextGeneration - now();
+        if (ahead > 0)
+            usleep((useconds_t) (ahead * 1e6));
+        else
+            nextGeneration = now();
     }
+    drawConfiguration(&renderer, n, configuration); // Always show the final generation.
+    freeRenderer(&renderer);
+
+    if (argc == 5)
+        writeConfiguration(argv[4], n, configuration);
 //    diff = clock() - start;
 
 //    long msec = diff * 1000 / CLOCKS_PER_SEC;
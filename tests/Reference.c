@@ -0,0 +1,186 @@
+/*
+Copyright (c) 2019 Andreas Ommundsen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+Input generator and reference stepper for tests/run_regression.sh. It shares no code with the four programs,
+so a bug in their kernels cannot hide in the expected output.
+
+    Reference rule1d {number} {functionDefinition.txt}          Wolfram rule 0..255.
+    Reference rule2d {seed} {functionDefinition.txt}            Random 512 entry table.
+    Reference config1d {seed} {n} {initialConfiguration.txt}
+    Reference config2d {seed} {n} {initialConfiguration.txt}
+    Reference step1d {functionDefinition.txt} {initialConfiguration.txt} {t} {finalConfiguration.txt}
+    Reference step2d {functionDefinition.txt} {initialConfiguration.txt} {t} {finalConfiguration.txt}
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void usage() {
+    fprintf(stderr, "Bad input. Expecting: {rule1d|rule2d|config1d|config2d|step1d|step2d} {arguments...}\n");
+    exit(EXIT_FAILURE);
+}
+
+FILE *openFile(char *fileName, char *mode) {
+    FILE *fp = fopen(fileName, mode);
+    if (fp == NULL) {
+        fprintf(stderr, "Could not open %s.\n", fileName);
+        exit(EXIT_FAILURE);
+    } else return fp;
+}
+
+unsigned long long nextRandom(unsigned long long *state) {
+    // xorshift64*, so the same seed gives the same inputs with every libc.
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ULL;
+}
+
+unsigned long long seedRandom(char *seed) {
+    unsigned long long state = strtoull(seed, NULL, 10) * 0x9E3779B97F4A7C15ULL + 1;
+    nextRandom(&state);
+    return state;
+}
+
+void writeRule(char *fileName, int bits, const char *table) {
+    FILE *fp = openFile(fileName, "w");
+    for (int i = 0; i < 1 << bits; ++i) {
+        for (int b = bits - 1; b >= 0; --b)
+            fputc('0' + ((i >> b) & 1), fp);
+        fprintf(fp, " %c\n", table[i]);
+    }
+    fclose(fp);
+}
+
+void readRule(char *fileName, char *table) {
+    FILE *fp = openFile(fileName, "r");
+    char index[16], value;
+    while (fscanf(fp, "%15s %c", index, &value) == 2)
+        table[strtol(index, NULL, 2)] = value;
+    fclose(fp);
+}
+
+char *readCells(char *fileName, int rows, int *n) {
+
+    // Reads the n header and rows lines of n cells, 1D files having a single row.
+    FILE *fp = openFile(fileName, "r");
+    if (fscanf(fp, "%d", n) != 1 || *n < 1) {
+        fprintf(stderr, "Bad configuration file %s.\n", fileName);
+        exit(EXIT_FAILURE);
+    }
+    if (rows != 1)
+        rows = *n;
+    char *cells = malloc((size_t) rows * (size_t) *n);
+    for (int i = 0; i < rows * *n; ++i) {
+        int c;
+        while ((c = fgetc(fp)) == '\n' || c == '\r' || c == ' ');
+        if (c != '0' && c != '1') {
+            fprintf(stderr, "Bad configuration file %s, expected %d cells.\n", fileName, rows * *n);
+            exit(EXIT_FAILURE);
+        }
+        cells[i] = (char) c;
+    }
+    fclose(fp);
+    return cells;
+}
+
+void writeCells(char *fileName, int rows, int n, const char *cells) {
+    FILE *fp = openFile(fileName, "w");
+    fprintf(fp, "%d\n", n);
+    for (int x = 0; x < rows; ++x)
+        fprintf(fp, "%.*s\n", n, cells + (size_t) x * (size_t) n);
+    fclose(fp);
+}
+
+void step1d(int n, int t, char *cells, const char *table) {
+    char *next = malloc((size_t) n);
+    for (int i = 0; i < t; ++i) {
+        for (int x = 0; x < n; ++x)
+            next[x] = table[4 * (cells[(x + n - 1) % n] - '0') + 2 * (cells[x] - '0') + (cells[(x + 1) % n] - '0')];
+        memcpy(cells, next, (size_t) n);
+    }
+    free(next);
+}
+
+void step2d(int n, int t, char *cells, const char *table) {
+    char *next = malloc((size_t) n * (size_t) n);
+    for (int i = 0; i < t; ++i) {
+        for (int x = 0; x < n; ++x) {
+            for (int y = 0; y < n; ++y) {
+                int index = 0;
+                for (int dx = -1; dx <= 1; ++dx)
+                    for (int dy = -1; dy <= 1; ++dy)
+                        index = 2 * index + (cells[((x + dx + n) % n) * n + (y + dy + n) % n] - '0');
+                next[x * n + y] = table[index];
+            }
+        }
+        memcpy(cells, next, (size_t) n * (size_t) n);
+    }
+    free(next);
+}
+
+int main(int argc, char **argv) {
+
+    if (argc < 2)
+        usage();
+    char *command = argv[1];
+
+    if (strcmp(command, "rule1d") == 0 && argc == 4) {
+        char table[8];
+        int rule = atoi(argv[2]);
+        for (int i = 0; i < 8; ++i)
+            table[i] = (char) ('0' + ((rule >> i) & 1));
+        writeRule(argv[3], 3, table);
+    } else if (strcmp(command, "rule2d") == 0 && argc == 4) {
+        char table[512];
+        unsigned long long state = seedRandom(argv[2]);
+        for (int i = 0; i < 512; ++i)
+            table[i] = (char) ('0' + (nextRandom(&state) >> 63));
+        writeRule(argv[3], 9, table);
+    } else if ((strcmp(command, "config1d") == 0 || strcmp(command, "config2d") == 0) && argc == 5) {
+        int n = atoi(argv[3]);
+        int rows = command[6] == '1' ? 1 : n;
+        unsigned long long state = seedRandom(argv[2]);
+        char *cells = malloc((size_t) rows * (size_t) n);
+        for (int i = 0; i < rows * n; ++i)
+            cells[i] = (char) ('0' + (nextRandom(&state) >> 63));
+        writeCells(argv[4], rows, n, cells);
+        free(cells);
+    } else if ((strcmp(command, "step1d") == 0 || strcmp(command, "step2d") == 0) && argc == 6) {
+        int is1d = command[4] == '1';
+        char table[512];
+        int n;
+        readRule(argv[2], table);
+        char *cells = readCells(argv[3], is1d ? 1 : 0, &n);
+        if (is1d)
+            step1d(n, atoi(argv[4]), cells, table);
+        else
+            step2d(n, atoi(argv[4]), cells, table);
+        writeCells(argv[5], is1d ? 1 : n, n, cells);
+        free(cells);
+    } else {
+        usage();
+    }
+    return 0;
+}
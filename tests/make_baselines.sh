@@ -0,0 +1,38 @@
+#!/bin/sh
+# Regenerates tests/baselines.txt from the timing logs in experiments/.
+#
+# Each log holds one wall time per run of a fixed number of generations. The generation count is not recorded,
+# so throughputs are only comparable within a directory. They are therefore stored relative to the p = 1 run
+# of the smallest k in the same directory:
+#
+#     relative(p, k) = (cells(k) / best time(p, k)) / (cells(k0) / best time(1, k0))
+#
+# In 1D_results k is log2 n (time doubles with k); in 2D_results_local k is n, with n * n cells.
+# The congested runs are left out, they measure the cluster's load rather than the programs.
+
+cd "$(dirname "$0")/.." || exit 1
+
+{
+    echo "# program p k relative_throughput"
+    echo "# Generated by tests/make_baselines.sh from experiments/, see there for the meaning of the columns."
+    for entry in "1-Parallel 1D_results 1" "2-Parallel 2D_results_local 2"; do
+        set -- $entry
+        for log in experiments/$2/p*_k*.log; do
+            name=$(basename "$log" .log)
+            p=${name#p}; p=${p%%_*}
+            k=${name#*_k}
+            best=$(awk 'NF { if (min == "" || $1 < min) min = $1 } END { print min }' "$log")
+            echo "$1 $p $k $best $3"
+        done
+    done | sort -k1,1 -k2,2n -k3,3n | awk '
+        {
+            cells = ($5 == 1) ? 2 ^ $3 : $3 * $3
+            thr[NR] = cells / $4; program[NR] = $1; p[NR] = $2; k[NR] = $3
+            if ($2 == 1 && (!($1 in k0) || $3 < k0[$1])) { k0[$1] = $3; ref[$1] = cells / $4 }
+        }
+        END {
+            for (i = 1; i <= NR; ++i)
+                if (program[i] in ref)
+                    printf "%s %d %d %.4f\n", program[i], p[i], k[i], thr[i] / ref[program[i]]
+        }'
+} > tests/baselines.txt
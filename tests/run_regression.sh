@@ -0,0 +1,188 @@
+#!/usr/bin/env bash
+# Cross-variant correctness and throughput regression suite. Exits non-zero when anything fails.
+#
+# Correctness: for TRIALS random rules and seeds per dimension, the final state of 1-Sequential and of 1-Parallel
+# for p = 1..MAX_RANKS (2-Sequential and 2-Parallel for 2D) must be bit-identical to tests/Reference. Every other
+# 1D trial uses an additive rule, which takes the jump-ahead path. n is random, so most runs split unevenly.
+# The parallel programs are also built with their optional modes switched (-DSTATISTICS=1 -DTOPOLOGY_AWARE=1,
+# and -DRUN_LENGTH_HALOS=0 for 2D) and checked the same way; the statistics file must hold one line per generation.
+#
+# Throughput: each entry of tests/baselines.txt with p <= PERF_RANKS is timed, as the difference between a run of
+# t generations and a run of none, median of REPS, and must reach TOLERANCE times its baseline. Baselines are
+# relative to the p = 1 run of the smallest k (see tests/make_baselines.sh). The machine is calibrated from the
+# median ratio of measured to baseline over all p = 1 entries, so one noisy run cannot shift every expectation.
+# TOLERANCE is loose because the baselines come from another machine: cache sizes alone move the relative
+# throughput of the larger k by tens of percent, while a real kernel regression costs a factor.
+#
+# Settings come from the environment:
+#   TRIALS=10 MAX_RANKS=4 SEED=1 PERF=1 PERF_RANKS=$(nproc) PERF_MAX_K1D=16 PERF_MAX_N2D=1024 REPS=5
+#   WORK_1D=67108864 WORK_2D=33554432 (cells * generations per timed run) TOLERANCE=0.5
+#   CC=cc MPICC=mpicc MPIRUN=mpirun
+
+set -u
+cd "$(dirname "$0")/.." || exit 1
+
+TRIALS=${TRIALS:-10}
+MAX_RANKS=${MAX_RANKS:-4}
+SEED=${SEED:-1}
+PERF=${PERF:-1}
+PERF_RANKS=${PERF_RANKS:-$(nproc 2>/dev/null || echo 1)}
+PERF_MAX_K1D=${PERF_MAX_K1D:-16}
+PERF_MAX_N2D=${PERF_MAX_N2D:-1024}
+REPS=${REPS:-5}
+WORK_1D=${WORK_1D:-67108864}
+WORK_2D=${WORK_2D:-33554432}
+TOLERANCE=${TOLERANCE:-0.5}
+CC=${CC:-cc}
+MPICC=${MPICC:-mpicc}
+MPIRUN=${MPIRUN:-mpirun}
+
+MPIRUN_FLAGS=()
+if "$MPIRUN" --version 2>&1 | grep -q "Open MPI"; then
+    MPIRUN_FLAGS+=(--oversubscribe)
+    [ "$(id -u)" = 0 ] && MPIRUN_FLAGS+=(--allow-run-as-root)
+fi
+
+W=$(mktemp -d)
+trap 'rm -rf "$W"' EXIT
+
+failures=0
+fail() {
+    echo "FAIL: $*"
+    failures=$((failures + 1))
+}
+
+echo "Building into $W"
+"$CC" -O2 -o "$W/Reference" tests/Reference.c &&
+"$CC" -O2 -o "$W/1-Sequential" 1-Sequential/Cellular1D-Sequential.c &&
+"$MPICC" -O2 -o "$W/1-Parallel" 1-Parallel/Cellular1D-Parallel.c &&
+"$CC" -O2 -DGENERATIONS_PER_SECOND=0 -o "$W/2-Sequential" 2-Sequential/Cellular2D-Sequential.c &&
+"$MPICC" -O2 -o "$W/2-Parallel" 2-Parallel/Cellular2D-Parallel.c &&
+"$MPICC" -O2 -DSTATISTICS=1 -DTOPOLOGY_AWARE=1 -DSTATISTICS_FILE="\"$W/statistics.txt\"" \
+    -o "$W/1-Parallel-statistics" 1-Parallel/Cellular1D-Parallel.c &&
+"$MPICC" -O2 -DSTATISTICS=1 -DTOPOLOGY_AWARE=1 -DSTATISTICS_FILE="\"$W/statistics.txt\"" \
+    -o "$W/2-Parallel-statistics" 2-Parallel/Cellular2D-Parallel.c &&
+"$MPICC" -O2 -DRUN_LENGTH_HALOS=0 -o "$W/2-Parallel-packed" 2-Parallel/Cellular2D-Parallel.c || { echo "FAIL: build"; exit 1; }
+
+run() { # {ranks or 0 for sequential} {program} {arguments...}
+    local p=$1 program=$2
+    shift 2
+    if [ "$p" = 0 ]; then
+        "$W/$program" "$@" < /dev/null > /dev/null 2>&1
+    else
+        "$MPIRUN" "${MPIRUN_FLAGS[@]}" -np "$p" "$W/$program" "$@" < /dev/null > /dev/null 2>&1
+    fi
+}
+
+compare() { # {label} {ranks or 0} {program} {rule} {configuration} {t}
+    rm -f "$W/out.txt"
+    run "$2" "$3" "$4" "$5" "$6" "$W/out.txt"
+    cmp -s "$W/expected.txt" "$W/out.txt" || fail "$1: $3 p=$2 differs from the reference"
+}
+
+compareStatistics() { # {label} {ranks} {program} {rule} {configuration} {t}
+    rm -f "$W/statistics.txt"
+    compare "$@"
+    [ "$(wc -l < "$W/statistics.txt" 2>/dev/null)" = "$6" ] || fail "$1: $3 p=$2 did not record $6 generations"
+}
+
+echo "Correctness: $TRIALS trials per dimension, p = 1..$MAX_RANKS, SEED=$SEED"
+RANDOM=$SEED
+additive=(60 90 102 150)
+for trial in $(seq 1 "$TRIALS"); do
+    if [ $((trial % 2)) = 1 ]; then
+        rule=${additive[RANDOM % 4]}
+        t=$((RANDOM % 5000))
+    else
+        rule=$((RANDOM % 256))
+        t=$((RANDOM % 200))
+    fi
+    n=$((MAX_RANKS + RANDOM % 300))
+    seed=$RANDOM
+    label="1D rule $rule n $n t $t seed $seed"
+    "$W/Reference" rule1d "$rule" "$W/rule.txt"
+    "$W/Reference" config1d "$seed" "$n" "$W/config.txt"
+    "$W/Reference" step1d "$W/rule.txt" "$W/config.txt" "$t" "$W/expected.txt"
+    compare "$label" 0 1-Sequential "$W/rule.txt" "$W/config.txt" "$t"
+    for p in $(seq 1 "$MAX_RANKS"); do
+        compare "$label" "$p" 1-Parallel "$W/rule.txt" "$W/config.txt" "$t"
+        compareStatistics "$label" "$p" 1-Parallel-statistics "$W/rule.txt" "$W/config.txt" "$t"
+    done
+
+    n=$((MAX_RANKS + RANDOM % 48))
+    t=$((RANDOM % 30))
+    seed=$RANDOM
+    label="2D rule seed $seed n $n t $t"
+    "$W/Reference" rule2d "$seed" "$W/rule.txt"
+    "$W/Reference" config2d "$seed" "$n" "$W/config.txt"
+    "$W/Reference" step2d "$W/rule.txt" "$W/config.txt" "$t" "$W/expected.txt"
+    compare "$label" 0 2-Sequential "$W/rule.txt" "$W/config.txt" "$t"
+    for p in $(seq 1 "$MAX_RANKS"); do
+        compare "$label" "$p" 2-Parallel "$W/rule.txt" "$W/config.txt" "$t"
+        compareStatistics "$label" "$p" 2-Parallel-statistics "$W/rule.txt" "$W/config.txt" "$t"
+        compare "$label" "$p" 2-Parallel-packed "$W/rule.txt" "$W/config.txt" "$t"
+    done
+done
+
+seconds() { # {ranks} {program} {rule} {configuration} {t}
+    local start end
+    start=$(date +%s.%N)
+    run "$@"
+    end=$(date +%s.%N)
+    awk -v s="$start" -v e="$end" 'BEGIN { print e - s }'
+}
+
+median() { # {numbers...}
+    printf "%s\n" "$@" | sort -g | awk '{ v[NR] = $1 } END { print NR % 2 ? v[(NR + 1) / 2] : (v[NR / 2] + v[NR / 2 + 1]) / 2 }'
+}
+
+throughput() { # {program} {ranks} {configuration} {cells} {t}: cells * generations per second, median of REPS.
+    local rep empty full runs=()
+    for rep in $(seq 1 "$REPS"); do
+        empty=$(seconds "$2" "$1" "$W/perf-rule-$1.txt" "$3" 0)
+        full=$(seconds "$2" "$1" "$W/perf-rule-$1.txt" "$3" "$5")
+        runs+=("$(awk -v f="$full" -v e="$empty" 'BEGIN { print f - e }')")
+    done
+    awk -v d="$(median "${runs[@]}")" -v c="$4" -v t="$5" 'BEGIN { if (d <= 0) print 0; else printf "%.0f\n", c * t / d }'
+}
+
+if [ "$PERF" = 1 ]; then
+    echo "Throughput: p <= $PERF_RANKS, median of $REPS, tolerance $TOLERANCE of tests/baselines.txt"
+    "$W/Reference" rule1d 30 "$W/perf-rule-1-Parallel.txt" # Not additive, so every generation is stepped.
+    "$W/Reference" rule2d 1 "$W/perf-rule-2-Parallel.txt"
+    entries=()
+    declare -A ratios
+    while read -r program p k relative; do
+        case "$program" in \#*|"") continue ;; esac
+        if [ "$program" = 1-Parallel ]; then
+            [ "$k" -le "$PERF_MAX_K1D" ] || continue
+            n=$((1 << k)); cells=$n; work=$WORK_1D; dimension=1d
+        else
+            [ "$k" -le "$PERF_MAX_N2D" ] || continue
+            n=$k; cells=$((n * n)); work=$WORK_2D; dimension=2d
+        fi
+        [ "$p" -le "$PERF_RANKS" ] || continue
+        t=$((work / cells > 0 ? work / cells : 1))
+        config="$W/perf-$dimension-$n.txt"
+        [ -f "$config" ] || "$W/Reference" "config$dimension" 1 "$n" "$config"
+
+        measured=$(throughput "$program" "$p" "$config" "$cells" "$t")
+        entries+=("$program $p $k $relative $measured")
+        [ "$p" = 1 ] && ratios[$program]+=" $(awk -v m="$measured" -v r="$relative" 'BEGIN { print m / r }')"
+    done < tests/baselines.txt
+
+    for entry in "${entries[@]}"; do
+        read -r program p k relative measured <<< "$entry"
+        # shellcheck disable=SC2086 # The ratios are a space separated list.
+        expected=$(awk -v r="$relative" -v c="$(median ${ratios[$program]})" 'BEGIN { printf "%.0f\n", r * c }')
+        echo "  $program p=$p k=$k: $measured cells/s, baseline $expected"
+        awk -v m="$measured" -v e="$expected" -v tol="$TOLERANCE" 'BEGIN { exit !(m < tol * e) }' &&
+            fail "$program p=$p k=$k: $measured cells/s is below $TOLERANCE * $expected"
+    done
+fi
+
+if [ "$failures" -gt 0 ]; then
+    echo "$failures failure(s)"
+    exit 1
+fi
+echo "All passed"